@@ -3,6 +3,127 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#ifdef RF_ACC_TRACE
+static rf_trace_t *rf_active_trace = NULL;
+
+static uint64_t rf_trace_cycles() {
+#if defined(__riscv)
+    uint64_t cycles;
+    asm volatile ("rdcycle %0" : "=r" (cycles));
+    return cycles;
+#else
+    return 0;
+#endif
+}
+
+// issued is the cycle the access (or the first read of a poll) started, which
+// is when the replay driver issues it
+static void rf_trace_log(rf_trace_op op, volatile uint64_t *addr, uint64_t data, uint64_t issued) {
+    rf_trace_t *trace = rf_active_trace;
+    if (!trace) {
+        return;
+    }
+
+    if (trace->header.num_records >= trace->capacity) {
+        trace->overflow = 1;
+        return;
+    }
+
+    uint64_t delta = trace->header.num_records ? issued - trace->last_cycle : 0;
+    rf_trace_record_t *record = &trace->records[trace->header.num_records++];
+    record->delta = delta > 0xffffffff ? 0xffffffff : (uint32_t)delta;
+    record->addr = ((uint32_t)op << RF_TRACE_OP_SHIFT) | ((uintptr_t)addr & RF_TRACE_ADDR_MASK);
+    record->data = data;
+    trace->last_cycle = issued;
+}
+
+void rf_trace_start(rf_trace_t *trace, rf_trace_record_t *records, size_t capacity) {
+    trace->header.magic = RF_TRACE_MAGIC;
+    trace->header.version = RF_TRACE_VERSION;
+    trace->header.csr_address = rf_acc_csr_address;
+    trace->header.scratchpad_address = rf_acc_scratchpad_address;
+    trace->header.num_records = 0;
+    trace->records = records;
+    trace->capacity = capacity;
+    trace->last_cycle = 0;
+    trace->overflow = 0;
+    rf_active_trace = trace;
+}
+
+void rf_trace_stop(void) {
+    rf_active_trace = NULL;
+}
+
+int rf_trace_save(const rf_trace_t *trace, const char *path) {
+    // A truncated trace would replay as a prefix and pass
+    if (trace->overflow) {
+        return 1;
+    }
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        return 1;
+    }
+
+    int result = fwrite(&trace->header, sizeof(trace->header), 1, fp) != 1;
+    size_t count = trace->header.num_records;
+    result = result || fwrite(trace->records, sizeof(rf_trace_record_t), count, fp) != count;
+    result = fclose(fp) || result;
+    return result;
+}
+#endif
+
+static inline void rf_acc_write(volatile uint64_t *addr, uint64_t data) {
+#ifdef RF_ACC_TRACE
+    uint64_t issued = rf_trace_cycles();
+#endif
+    *addr = data;
+#ifdef RF_ACC_TRACE
+    rf_trace_log(RF_TRACE_WRITE, addr, data, issued);
+#endif
+}
+
+static inline uint64_t rf_acc_read(volatile uint64_t *addr) {
+#ifdef RF_ACC_TRACE
+    uint64_t issued = rf_trace_cycles();
+#endif
+    uint64_t data = *addr;
+#ifdef RF_ACC_TRACE
+    rf_trace_log(RF_TRACE_READ, addr, data, issued);
+#endif
+    return data;
+}
+
+// Spin until any bit of mask is set, logged as a single poll record
+static inline void rf_acc_poll(volatile uint64_t *addr, uint64_t mask) {
+#ifdef RF_ACC_TRACE
+    uint64_t issued = rf_trace_cycles();
+#endif
+    while (!(*addr & mask)) { continue; };
+#ifdef RF_ACC_TRACE
+    rf_trace_log(RF_TRACE_POLL, addr, mask, issued);
+#endif
+}
+
+// Spin until every bit of mask is clear, logged as a single poll record
+static inline void rf_acc_poll_clear(volatile uint64_t *addr, uint64_t mask) {
+#ifdef RF_ACC_TRACE
+    uint64_t issued = rf_trace_cycles();
+#endif
+    while (*addr & mask) { continue; };
+#ifdef RF_ACC_TRACE
+    rf_trace_log(RF_TRACE_POLL_CLEAR, addr, mask, issued);
+#endif
+}
+
+static void rf_write_meta(const rf_acc_t *self) {
+    volatile uint64_t *csr_ptr = (volatile uint64_t *) rf_acc_csr_address;
+    int64_t val = self->num_trees;
+    val += (self->num_classes << 10);
+    val += ((int64_t)self->node_format << 20);
+    rf_acc_write(&csr_ptr[3], val);
+}
+
 rf_acc_t* rf_init(rf_error_codes *res,
     int num_features,
     int num_classes,
@@ -36,11 +157,6 @@ rf_acc_t* rf_init(rf_error_codes *res,
         return NULL;
     }
 
-    volatile uint64_t *csr_ptr = (volatile uint64_t *) rf_acc_csr_address;
-    int64_t val = num_trees;
-    val += (num_classes << 10);
-    csr_ptr[3] = val;
-
     rf_acc_t *self = malloc(sizeof(rf_acc_t));
     if (!self) {
         *res = MALLOC_ERROR;
@@ -52,6 +168,15 @@ rf_acc_t* rf_init(rf_error_codes *res,
     self->num_trees = num_trees;
     self->num_nodes = num_nodes;
     self->depth = depth;
+    self->node_format = RF_NODE_FORMAT_WIDE;
+    for (int i = 0; i < num_features; i++) {
+        self->scale[i] = rf_acc_fixed_point_bp_width;
+    }
+    rf_write_meta(self);
+
+    // The meta register reads back the walker count in bits 31:24
+    volatile uint64_t *csr_ptr = (volatile uint64_t *) rf_acc_csr_address;
+    self->num_walkers = (rf_acc_read(&csr_ptr[3]) >> 24) & 0xff;
 
     *res = RF_SUCCESS;
     return self;
@@ -78,6 +203,34 @@ static int32_t toFixedPoint(float x) {
     return roundi(x * BP_SCALE);
 }
 
+static double scaleFactor(int scale) {
+    return scale >= 0 ? (double)(1 << scale) : 1.0 / (double)(1 << -scale);
+}
+
+// Saturates instead of wrapping so the accuracy report sees the value the hardware gets
+static int32_t toFixedPointScaled(float x, int scale) {
+    double scaled = x * scaleFactor(scale);
+    if (scaled >= INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (scaled <= INT32_MIN) {
+        return INT32_MIN;
+    }
+    return roundi(scaled);
+}
+
+// Checked in double, the scaled threshold can be far outside the int32 range
+static int fitsCompactThreshold(double max_abs, int scale) {
+    return max_abs * scaleFactor(scale) < rf_acc_compact_threshold_max + 0.5;
+}
+
+static int32_t toCandidate(const rf_acc_t *self, float x, int feature) {
+    if (self->node_format == RF_NODE_FORMAT_COMPACT) {
+        return toFixedPointScaled(x, self->scale[feature]);
+    }
+    return toFixedPoint(x);
+}
+
 rf_hw_node_t convert_to_hw_node(const rf_node_t *node) {
     rf_hw_node_t hw_node = 0;
 
@@ -91,6 +244,148 @@ rf_hw_node_t convert_to_hw_node(const rf_node_t *node) {
     return hw_node;
 }
 
+// Compact node: leaf bit, 5-bit feature/class, 10-bit right offset and a 16-bit
+// threshold in the feature's scale. The left child is always the next node.
+static uint32_t convert_to_compact_hw_node(const rf_acc_t *self, const rf_node_t *node) {
+    uint32_t hw_node = 0;
+
+    hw_node += ((uint32_t)(node->is_leaf) << 31);
+    hw_node += ((uint32_t)(node->feature) << 26);
+    if (!node->is_leaf) {
+        hw_node += ((uint32_t)node->right << 16);
+        hw_node += (uint16_t)toFixedPointScaled(node->threshold, self->scale[node->feature]);
+    }
+
+    return hw_node;
+}
+
+// Walk a tree from root, comparing in the compact fixed point format when scale is given
+static int rf_tree_predict(const rf_node_t *node, const int size, int idx, const float *sample, const int *scale) {
+    for (int steps = 0; idx >= 0 && idx < size && steps < size; steps++) {
+        const rf_node_t *n = &node[idx];
+        if (n->is_leaf) {
+            return n->feature;
+        }
+
+        int left;
+        if (scale) {
+            int s = scale[n->feature];
+            left = toFixedPointScaled(sample[n->feature], s) <= toFixedPointScaled(n->threshold, s);
+        } else {
+            left = sample[n->feature] <= n->threshold;
+        }
+        idx += left ? n->left : n->right;
+    }
+    return -1;
+}
+
+// Majority vote as done by the accelerator, the lowest class wins a tie
+static int rf_forest_predict(const rf_acc_t *self, const rf_node_t *node, const int size, const int* offsets,
+    const float *sample, const int *scale, int *votes) {
+    int count[RF_ACC_META_MAX_CLASSES];
+    for (int c = 0; c < RF_ACC_META_MAX_CLASSES; c++) {
+        count[c] = 0;
+    }
+
+    for (int t = 0; t < self->num_trees; t++) {
+        votes[t] = rf_tree_predict(node, size, offsets[t], sample, scale);
+        if (votes[t] >= 0 && votes[t] < RF_ACC_META_MAX_CLASSES) {
+            count[votes[t]]++;
+        }
+    }
+
+    int decision = 0;
+    for (int c = 1; c < self->num_classes; c++) {
+        if (count[c] > count[decision]) {
+            decision = c;
+        }
+    }
+    return decision;
+}
+
+int rf_compact_model(rf_acc_t *self, const rf_node_t *node, const int size, const int* offsets, const int offsetSize,
+    const float *samples, const int num_samples, rf_compact_report_t *report) {
+    if (offsetSize > 127 || offsetSize < self->num_trees) {
+        return 1;
+    }
+
+    double max_abs[RF_ACC_META_MAX_FEATURES];
+    for (int f = 0; f < self->num_features; f++) {
+        max_abs[f] = 0.0;
+    }
+
+    for (int i = 0; i < size; i++) {
+        const rf_node_t *n = &node[i];
+        if (n->feature < 0 || n->feature > rf_acc_compact_max_feature_class) {
+            return 1;
+        }
+        if (n->is_leaf) {
+            continue;
+        }
+        if (n->feature >= self->num_features || n->left != 1 || n->right < 1 || n->right > rf_acc_compact_max_right) {
+            return 1;
+        }
+        double t = n->threshold < 0 ? -n->threshold : n->threshold;
+        if (t > max_abs[n->feature]) {
+            max_abs[n->feature] = t;
+        }
+    }
+
+    // Finest binary point at which every threshold of the feature still fits in 16 bits
+    int scale[RF_ACC_META_MAX_FEATURES];
+    for (int f = 0; f < self->num_features; f++) {
+        int s = rf_acc_fixed_point_bp_width;
+        while (s > -rf_acc_fixed_point_bp_width && !fitsCompactThreshold(max_abs[f], s)) {
+            s--;
+        }
+        if (!fitsCompactThreshold(max_abs[f], s)) {
+            return 1;
+        }
+        scale[f] = s;
+    }
+
+    if (report) {
+        report->max_threshold_error = 0.0;
+        report->changed_votes = 0;
+        report->changed_decisions = 0;
+
+        for (int i = 0; i < size; i++) {
+            const rf_node_t *n = &node[i];
+            if (n->is_leaf) {
+                continue;
+            }
+            int s = scale[n->feature];
+            double error = n->threshold - toFixedPointScaled(n->threshold, s) / scaleFactor(s);
+            error = error < 0 ? -error : error;
+            if (error > report->max_threshold_error) {
+                report->max_threshold_error = error;
+            }
+        }
+
+        int *votes = malloc(2 * self->num_trees * sizeof(int));
+        if (!votes) {
+            return 1;
+        }
+        for (int i = 0; i < num_samples; i++) {
+            const float *sample = &samples[i * self->num_features];
+            int expected = rf_forest_predict(self, node, size, offsets, sample, NULL, votes);
+            int actual = rf_forest_predict(self, node, size, offsets, sample, scale, votes + self->num_trees);
+            for (int t = 0; t < self->num_trees; t++) {
+                report->changed_votes += votes[t] != votes[self->num_trees + t];
+            }
+            report->changed_decisions += expected != actual;
+        }
+        free(votes);
+    }
+
+    for (int f = 0; f < self->num_features; f++) {
+        self->scale[f] = scale[f];
+    }
+    self->node_format = RF_NODE_FORMAT_COMPACT;
+    rf_write_meta(self);
+    return 0;
+}
+
 int rf_store_weights(rf_acc_t *self, const rf_node_t *node, const int size, const int* offsets, const int offsetSize) {
     volatile uint64_t *spad_ptr = (volatile uint64_t *) rf_acc_scratchpad_address;
 
@@ -100,32 +395,45 @@ int rf_store_weights(rf_acc_t *self, const rf_node_t *node, const int size, cons
     }
 
     for (int i=0; i < offsetSize; i++) {
-        spad_ptr[i] = offsets[i];
+        rf_acc_write(&spad_ptr[i], offsets[i]);
+    }
+
+    // Start address of weights, two compact nodes share a word with the even node in the low half
+    if (self->node_format == RF_NODE_FORMAT_COMPACT) {
+        for (int i = 0; i < size; i += 2) {
+            uint64_t hw_weight = convert_to_compact_hw_node(self, &node[i]);
+            if (i + 1 < size) {
+                hw_weight += ((uint64_t)convert_to_compact_hw_node(self, &node[i + 1]) << 32);
+            }
+            rf_acc_write(&spad_ptr[128 + i / 2], hw_weight);
+        }
+        return 0;
     }
 
-    // Start address of weights
     for (int i = 0; i < size; i++) {
         uint64_t hw_weight = convert_to_hw_node(&node[i]);
-        spad_ptr[128 + i] = hw_weight;
+        rf_acc_write(&spad_ptr[128 + i], hw_weight);
     }
     return 0;
 }
 
 int rf_classify(rf_acc_t *self, float *candidates, int size) {
     volatile uint64_t *csr_ptr = (volatile uint64_t *) rf_acc_csr_address;
+    // After a tree error the other walkers keep the accelerator busy until their trees finish
+    rf_acc_poll_clear(&csr_ptr[0], 2);
     // TODO: Change this
-    if (!csr_ptr[0]) {
+    if (!rf_acc_read(&csr_ptr[0])) {
         for (int i=0; i < self->num_features-1; i++) {
-            csr_ptr[1] = (0x00000000ffffffff & (int64_t)toFixedPoint(candidates[i]));
+            rf_acc_write(&csr_ptr[1], (0x00000000ffffffff & (int64_t)toCandidate(self, candidates[i], i)));
         }
 	
         // Mark last to start the computation
-        uint64_t val = (0x00000000ffffffff & (int64_t)(toFixedPoint(candidates[self->num_features-1])));
+        uint64_t val = (0x00000000ffffffff & (int64_t)(toCandidate(self, candidates[self->num_features-1], self->num_features-1)));
         val += 1LL << 50;
-        csr_ptr[1] = val;
-        while (!(csr_ptr[0] & 1)) { continue; };
+        rf_acc_write(&csr_ptr[1], val);
+        rf_acc_poll(&csr_ptr[0], 1);
 
-        return csr_ptr[2];
+        return rf_acc_read(&csr_ptr[2]);
     }
     return -1;
 }
@@ -6,20 +6,36 @@
 static const int rf_acc_csr_address = 0x1100;
 static const int rf_acc_scratchpad_address = 0x200000;
 
-static const int rf_acc_meta_max_features = 10;
-static const int rf_acc_meta_max_classes = 10;
+#define RF_ACC_META_MAX_FEATURES 10
+#define RF_ACC_META_MAX_CLASSES 10
+
+static const int rf_acc_meta_max_features = RF_ACC_META_MAX_FEATURES;
+static const int rf_acc_meta_max_classes = RF_ACC_META_MAX_CLASSES;
 static const int rf_acc_meta_max_trees = 100;
 static const int rf_acc_meta_max_nodes = 1000;
 static const int rf_acc_meta_max_depth = 16;
 static const int rf_acc_fixed_point_width = 32;
 static const int rf_acc_fixed_point_bp_width = 16;
 
+static const int rf_acc_compact_threshold_max = 32767;
+static const int rf_acc_compact_max_feature_class = 31;
+static const int rf_acc_compact_max_right = 1023;
+
+typedef enum {
+    RF_NODE_FORMAT_WIDE = 0,
+    RF_NODE_FORMAT_COMPACT = 1
+} rf_node_format;
+
 typedef struct {
     int num_features;
     int num_classes;
     int num_trees;
     int num_nodes;
     int depth;
+    int num_walkers;  // Trees the accelerator walks concurrently
+    rf_node_format node_format;
+    // Binary point of the thresholds and candidates of each feature in the compact format
+    int scale[RF_ACC_META_MAX_FEATURES];
 } rf_acc_t;
 
 typedef struct {
@@ -32,6 +48,12 @@ typedef struct {
 
 typedef uint64_t rf_hw_node_t;
 
+typedef struct {
+    double max_threshold_error;  // Largest difference between a threshold and its quantized value
+    int changed_votes;           // Tree votes over the samples that differ from the float model
+    int changed_decisions;       // Forest decisions over the samples that differ from the float model
+} rf_compact_report_t;
+
 typedef enum {
     ARGUMENT_GREATER_THAN_MAX_SUPPORTED,
     ARGUMENT_ZERO_ERROR,
@@ -49,6 +71,25 @@ rf_acc_t* rf_init(rf_error_codes *res,
 int rf_delete(rf_acc_t *self);
 int rf_store_weights(rf_acc_t *self, const rf_node_t *node, const int size, const int* offsets, const int offsetSize);
 
+// Switch the model to the compact 32-bit node format, must be called before rf_store_weights.
+// samples holds num_samples rows of num_features values used to report the accuracy loss.
+// Returns 1 and keeps the wide format when the trees cannot be encoded compactly.
+int rf_compact_model(rf_acc_t *self, const rf_node_t *node, const int size, const int* offsets, const int offsetSize,
+    const float *samples, const int num_samples, rf_compact_report_t *report);
+
+// Waits for walkers left over from a classification that stopped on an error, then returns
+// the decision. Returns -1 when an earlier decision was never read.
 int rf_classify(rf_acc_t *self, float *candidates, int size);
 
+#ifdef RF_ACC_TRACE
+#include "rf-trace.h"
+
+// Record every CSR and scratchpad access made by the SDK into records,
+// dropping accesses once capacity is reached (trace->overflow is set and
+// rf_trace_save refuses to write the truncated trace).
+void rf_trace_start(rf_trace_t *trace, rf_trace_record_t *records, size_t capacity);
+void rf_trace_stop(void);
+int rf_trace_save(const rf_trace_t *trace, const char *path);
+#endif
+
 #endif
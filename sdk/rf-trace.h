@@ -0,0 +1,54 @@
+#ifndef RF_TRACE_H
+#define RF_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary layout of an MMIO trace recorded by the SDK and replayed by the
+// Verilator replay driver. A trace file is one header followed by
+// header.num_records records, all little-endian.
+
+#define RF_TRACE_MAGIC 0x52544652u  // "RFTR"
+#define RF_TRACE_VERSION 1u
+
+typedef enum {
+    RF_TRACE_READ = 0,        // Single read, data is the value observed
+    RF_TRACE_WRITE = 1,       // Single write, data is the value written
+    RF_TRACE_POLL = 2,        // Repeated reads until (value & data) != 0
+    RF_TRACE_POLL_CLEAR = 3   // Repeated reads until (value & data) == 0
+} rf_trace_op;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t csr_address;
+    uint64_t scratchpad_address;
+    uint64_t num_records;
+} rf_trace_header_t;
+
+typedef struct {
+    uint32_t delta;  // Cycles between the start of the previous access and this one, saturating
+    uint32_t addr;   // [31:30] op, [29:0] bus address
+    uint64_t data;
+} rf_trace_record_t;
+
+#define RF_TRACE_OP_SHIFT 30
+#define RF_TRACE_ADDR_MASK 0x3fffffffu
+
+static inline rf_trace_op rf_trace_record_op(const rf_trace_record_t *record) {
+    return (rf_trace_op)(record->addr >> RF_TRACE_OP_SHIFT);
+}
+
+static inline uint32_t rf_trace_record_addr(const rf_trace_record_t *record) {
+    return record->addr & RF_TRACE_ADDR_MASK;
+}
+
+typedef struct {
+    rf_trace_header_t header;
+    rf_trace_record_t *records;
+    size_t capacity;
+    uint64_t last_cycle;
+    int overflow;
+} rf_trace_t;
+
+#endif
@@ -0,0 +1,156 @@
+#include <iostream>
+#include <ostream>
+#include <fstream>
+#include <string.h>
+#include "rf_trace_replay_sim.h"
+
+// Give up on a poll after this many cycles
+static const uint64_t timeout_cycles = 1000000;
+
+RFTraceReplaySim::RFTraceReplaySim(char *vcd_filename) : TLMMIOSim(vcd_filename) {}
+
+bool RFTraceReplaySim::load(const char *trace_filename) {
+  std::ifstream in(trace_filename, std::ios::binary);
+  if (!in) {
+    std::cerr << "Unable to open " << trace_filename << std::endl;
+    return false;
+  }
+
+  in.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!in || header.magic != RF_TRACE_MAGIC || header.version != RF_TRACE_VERSION) {
+    std::cerr << trace_filename << " is not a version " << RF_TRACE_VERSION << " MMIO trace" << std::endl;
+    return false;
+  }
+
+  if (header.csr_address != harness_csr_address || header.scratchpad_address != harness_scratchpad_address) {
+    std::cerr << "Trace was recorded with csr 0x" << std::hex << header.csr_address << " scratchpad 0x"
+              << header.scratchpad_address << ", harness uses csr 0x" << harness_csr_address
+              << " scratchpad 0x" << harness_scratchpad_address << std::dec << std::endl;
+    return false;
+  }
+
+  records.resize(header.num_records);
+  in.read(reinterpret_cast<char *>(records.data()), records.size() * sizeof(rf_trace_record_t));
+  if (!in) {
+    std::cerr << "Trace is truncated, expected " << header.num_records << " records" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool RFTraceReplaySim::replay(bool timed) {
+  bool pass = true;
+  unsigned mismatch_cnt = 0;
+  unsigned poll_cnt = 0;
+  uint64_t poll_cycles = 0;
+  uint64_t slip_cycles = 0;
+
+  reset();
+
+  uint64_t start = cycles;
+  uint64_t target = cycles;
+
+  for (size_t i = 0; i < records.size(); i++) {
+    const rf_trace_record_t &record = records[i];
+    rf_trace_op op = rf_trace_record_op(&record);
+    uint64_t addr = rf_trace_record_addr(&record);
+    uint64_t resp = 0;
+    bool ok = true;
+
+    // Keep the recorded gap between access issues; when the model is slower than
+    // the field run, re-anchor on the current cycle and account the slip
+    target += record.delta;
+    if (timed) {
+      while (cycles < target) step();
+      if (cycles > target) {
+        slip_cycles += cycles - target;
+        target = cycles;
+      }
+    }
+
+    switch (op) {
+      case RF_TRACE_WRITE:
+        ok = access(true, addr, record.data, &resp);
+        break;
+      case RF_TRACE_READ:
+        ok = access(false, addr, 0, &resp);
+        if (ok && resp != record.data) {
+          std::cout << "Mismatch at record " << i << " address 0x" << std::hex << addr << " expected 0x"
+                    << record.data << " actual 0x" << resp << std::dec << std::endl;
+          mismatch_cnt++;
+          pass = false;
+        }
+        break;
+      case RF_TRACE_POLL:
+      case RF_TRACE_POLL_CLEAR: {
+        bool until_set = op == RF_TRACE_POLL;
+        uint64_t poll_start = cycles;
+        uint64_t deadline = cycles + timeout_cycles;
+        do {
+          ok = access(false, addr, 0, &resp) && cycles < deadline;
+        } while (ok && ((resp & record.data) != 0) != until_set);
+        poll_cnt++;
+        poll_cycles += cycles - poll_start;
+        break;
+      }
+      default:
+        std::cerr << "Unknown op " << op << " at record " << i << std::endl;
+        return false;
+    }
+
+    if (!ok) {
+      std::cout << "Bus access timed out or was denied at record " << i << " address 0x" << std::hex << addr
+                << std::dec << std::endl;
+      return false;
+    }
+
+    if (!timed) target = cycles;
+  }
+
+  std::cout << "Records replayed: " << records.size() << std::endl;
+  std::cout << "Read mismatches detected: " << mismatch_cnt << std::endl;
+  std::cout << "Total cycles: " << cycles - start << std::endl;
+  if (poll_cnt) {
+    std::cout << "Polls: " << poll_cnt << " average cycles per poll: " << double(poll_cycles) / poll_cnt << std::endl;
+  }
+  if (timed) {
+    std::cout << "Cycles behind the recorded schedule: " << slip_cycles << std::endl;
+  }
+  return pass;
+}
+
+int main(int argc, char *argv[]) {
+  bool timed = true;
+  int argi = 1;
+  if (argi < argc && strcmp(argv[argi], "--untimed") == 0) {
+    timed = false;
+    argi++;
+  }
+
+#if VM_TRACE
+  if (argc - argi != 2) {
+    std::cerr << "Usage: " << argv[0] << " [--untimed] tracefile vcdfile" << std::endl;
+#else
+  if (argc - argi != 1) {
+    std::cerr << "Usage: " << argv[0] << " [--untimed] tracefile" << std::endl;
+#endif
+    exit(1);
+  }
+
+#if VM_TRACE
+  RFTraceReplaySim *tb = new RFTraceReplaySim(argv[argi + 1]);
+#else
+  RFTraceReplaySim *tb = new RFTraceReplaySim(NULL);
+#endif
+
+  if (!tb->load(argv[argi])) {
+    exit(1);
+  }
+
+  if (tb->replay(timed)) {
+    std::cout << "REPLAY PASSED\n";
+    exit(0);
+  }
+  std::cout << "REPLAY FAILED\n";
+  exit(1);
+}
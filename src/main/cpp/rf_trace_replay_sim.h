@@ -0,0 +1,20 @@
+#ifndef RF_TRACE_REPLAY_SIM_H_
+#define RF_TRACE_REPLAY_SIM_H_
+
+#include <vector>
+
+#include "tl_mmio_sim.h"
+#include "rf-trace.h"
+
+class RFTraceReplaySim : public TLMMIOSim {
+    public:
+        RFTraceReplaySim(char* vcd_filename);
+        bool load(const char* trace_filename);
+        bool replay(bool timed);
+
+    private:
+        rf_trace_header_t header;
+        std::vector<rf_trace_record_t> records;
+};
+
+#endif // RF_TRACE_REPLAY_SIM_H_
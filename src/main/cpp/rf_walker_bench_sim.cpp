@@ -0,0 +1,187 @@
+#include <iostream>
+#include <ostream>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include "rf_walker_bench_sim.h"
+
+static const int num_features = 10;
+static const int num_classes = 3;
+static const int fixed_point_bp_width = 16;
+
+// Offset table fills the first 128 words, the nodes follow
+static const int node_base = 128;
+static const int scratchpad_words = 0x20000 / 8;
+
+// A walk longer than the default maxDepth of WithTLRandomForest is reported as an error
+static const int max_bench_depth = 8;
+
+static const uint64_t poll_timeout_cycles = 1000000;
+
+static std::mt19937 rng(1626);
+
+RFWalkerBenchSim::RFWalkerBenchSim(char *vcd_filename) : TLMMIOSim(vcd_filename) {}
+
+// Append a full tree in pre-order, the left child always follows its parent
+int RFWalkerBenchSim::buildTree(int depth) {
+  int idx = nodes.size();
+  nodes.push_back(BenchNode());
+
+  if (depth == 0) {
+    nodes[idx] = {true, int(rng() % num_classes), 0, 0, 0};
+    return 1;
+  }
+
+  int32_t threshold = int32_t(rng() % (16 << fixed_point_bp_width)) - (8 << fixed_point_bp_width);
+  int left_size = buildTree(depth - 1);
+  int right_size = buildTree(depth - 1);
+  nodes[idx] = {false, int(rng() % num_features), threshold, 1, 1 + left_size};
+  return 1 + left_size + right_size;
+}
+
+// Same walk and majority vote as the accelerator, the lowest class wins a tie
+int RFWalkerBenchSim::predict(const std::vector<int32_t> &candidates) {
+  int votes[num_classes] = {0};
+  for (int root : offsets) {
+    int idx = root;
+    while (!nodes[idx].is_leaf) {
+      const BenchNode &node = nodes[idx];
+      idx += candidates[node.feature] <= node.threshold ? node.left : node.right;
+    }
+    votes[nodes[idx].feature]++;
+  }
+
+  int decision = 0;
+  for (int c = 1; c < num_classes; c++) {
+    if (votes[c] > votes[decision]) decision = c;
+  }
+  return decision;
+}
+
+bool RFWalkerBenchSim::run(int num_trees, int depth, int num_runs) {
+  nodes.clear();
+  offsets.clear();
+  for (int t = 0; t < num_trees; t++) {
+    offsets.push_back(nodes.size());
+    buildTree(depth);
+  }
+
+  if (num_trees > 100 || depth > max_bench_depth || node_base + int(nodes.size()) > scratchpad_words) {
+    std::cerr << num_trees << " trees of depth " << depth << " do not fit the accelerator" << std::endl;
+    return false;
+  }
+
+  reset();
+
+  uint64_t meta;
+  bool ok = write(harness_csr_address + 24, num_trees + (num_classes << 10));
+  ok = ok && read(harness_csr_address + 24, &meta);
+  int num_walkers = (meta >> 24) & 0xff;
+
+  for (size_t i = 0; ok && i < offsets.size(); i++) {
+    ok = write(harness_scratchpad_address + i * 8, offsets[i]);
+  }
+
+  for (size_t i = 0; ok && i < nodes.size(); i++) {
+    const BenchNode &node = nodes[i];
+    uint64_t hw_node = 0;
+    hw_node += (uint64_t(node.is_leaf) << 63);
+    hw_node += (uint64_t(node.feature) << 54);
+    hw_node += ((uint64_t(uint32_t(node.threshold))) << 22);
+    hw_node += (uint64_t(node.left) << 11);
+    hw_node += uint64_t(node.right);
+    ok = write(harness_scratchpad_address + (node_base + i) * 8, hw_node);
+  }
+
+  if (!ok) {
+    std::cerr << "Bus access timed out while loading the forest" << std::endl;
+    return false;
+  }
+
+  unsigned mismatch_cnt = 0;
+  uint64_t total_latency = 0;
+
+  for (int run = 0; run < num_runs; run++) {
+    std::vector<int32_t> candidates;
+    for (int f = 0; f < num_features; f++) {
+      candidates.push_back(int32_t(rng() % (20 << fixed_point_bp_width)) - (10 << fixed_point_bp_width));
+    }
+
+    for (int f = 0; ok && f < num_features - 1; f++) {
+      ok = write(harness_csr_address + 8, uint32_t(candidates[f]));
+    }
+
+    // Latency runs from the write marking the last candidate to the decision being visible
+    uint64_t start = cycles;
+    uint64_t deadline = cycles + poll_timeout_cycles;
+    uint64_t csr = 0;
+    ok = ok && write(harness_csr_address + 8, uint32_t(candidates[num_features - 1]) + (1ULL << 50));
+    while (ok && !(csr & 1)) {
+      ok = read(harness_csr_address, &csr) && cycles < deadline;
+    }
+    total_latency += cycles - start;
+
+    uint64_t result;
+    ok = ok && read(harness_csr_address + 16, &result);
+    if (!ok) {
+      std::cerr << "Bus access timed out during classification " << run << std::endl;
+      return false;
+    }
+
+    int expected = predict(candidates);
+    int error = (result >> 32) & 0x3;
+    int decision = result & 0xffffffff;
+    if (error || decision != expected) {
+      std::cout << "Mismatch at classification " << run << " expected: " << expected << " actual: " << decision
+                << " error: " << error << std::endl;
+      mismatch_cnt++;
+    }
+  }
+
+  std::cout << "Walkers: " << num_walkers << " Trees: " << num_trees << " Depth: " << depth
+            << " Classifications: " << num_runs << std::endl;
+  std::cout << "Mismatches with software detected: " << mismatch_cnt << std::endl;
+  std::cout << "Average latency in cycles: " << double(total_latency) / num_runs << std::endl;
+  return mismatch_cnt == 0;
+}
+
+int main(int argc, char *argv[]) {
+  int num_trees = 32;
+  int depth = 6;
+  int num_runs = 20;
+  char *vcd_filename = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--trees") == 0 && i + 1 < argc) {
+      num_trees = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+      depth = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+      num_runs = atoi(argv[++i]);
+    } else if (!vcd_filename) {
+      vcd_filename = argv[i];
+    } else {
+      vcd_filename = NULL;
+      break;
+    }
+  }
+
+#if VM_TRACE
+  if (!vcd_filename || num_trees < 1 || depth < 0 || num_runs < 1) {
+    std::cerr << "Usage: " << argv[0] << " [--trees N] [--depth N] [--runs N] vcdfile" << std::endl;
+#else
+  if (vcd_filename || num_trees < 1 || depth < 0 || num_runs < 1) {
+    std::cerr << "Usage: " << argv[0] << " [--trees N] [--depth N] [--runs N]" << std::endl;
+#endif
+    exit(1);
+  }
+
+  RFWalkerBenchSim *tb = new RFWalkerBenchSim(vcd_filename);
+
+  if (tb->run(num_trees, depth, num_runs)) {
+    std::cout << "BENCH PASSED\n";
+    exit(0);
+  }
+  std::cout << "BENCH FAILED\n";
+  exit(1);
+}
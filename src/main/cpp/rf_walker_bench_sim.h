@@ -0,0 +1,29 @@
+#ifndef RF_WALKER_BENCH_SIM_H_
+#define RF_WALKER_BENCH_SIM_H_
+
+#include <vector>
+
+#include "tl_mmio_sim.h"
+
+struct BenchNode {
+  bool is_leaf;
+  int feature;
+  int32_t threshold;
+  int left;
+  int right;
+};
+
+class RFWalkerBenchSim : public TLMMIOSim {
+    public:
+        RFWalkerBenchSim(char* vcd_filename);
+        bool run(int num_trees, int depth, int num_runs);
+
+    private:
+        int buildTree(int depth);
+        int predict(const std::vector<int32_t>& candidates);
+
+        std::vector<BenchNode> nodes;
+        std::vector<int> offsets;
+};
+
+#endif // RF_WALKER_BENCH_SIM_H_
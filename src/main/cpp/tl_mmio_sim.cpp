@@ -0,0 +1,59 @@
+#include "tl_mmio_sim.h"
+
+// TileLink opcodes and the 8 byte access size used by the SDK
+static const int tl_a_put_full_data = 0;
+static const int tl_a_get = 4;
+static const int tl_lg_size = 3;
+
+// Give up on a bus access after this many cycles
+static const uint64_t access_timeout_cycles = 1000000;
+
+TLMMIOSim::TLMMIOSim(char *vcd_filename) : Simulator(vcd_filename) {
+  dut->tl_a_valid = 0;
+  dut->tl_d_ready = 0;
+}
+
+bool TLMMIOSim::access(bool write, uint64_t addr, uint64_t data, uint64_t *resp) {
+  uint64_t deadline = cycles + access_timeout_cycles;
+
+  dut->tl_a_valid = 1;
+  dut->tl_a_bits_opcode = write ? tl_a_put_full_data : tl_a_get;
+  dut->tl_a_bits_param = 0;
+  dut->tl_a_bits_size = tl_lg_size;
+  dut->tl_a_bits_source = 0;
+  dut->tl_a_bits_address = addr;
+  dut->tl_a_bits_mask = 0xff;
+  dut->tl_a_bits_data = write ? data : 0;
+  dut->tl_a_bits_corrupt = 0;
+  dut->tl_d_ready = 1;
+  eval();
+
+  while (!dut->tl_a_ready) {
+    if (cycles >= deadline) return false;
+    step();
+  }
+  step();
+  dut->tl_a_valid = 0;
+  eval();
+
+  while (!dut->tl_d_valid) {
+    if (cycles >= deadline) return false;
+    step();
+  }
+  // Sample the whole beat before the handshake lets the D queue move on
+  *resp = dut->tl_d_bits_data;
+  bool denied = dut->tl_d_bits_denied;
+  step();
+  dut->tl_d_ready = 0;
+  eval();
+  return !denied;
+}
+
+bool TLMMIOSim::write(uint64_t addr, uint64_t data) {
+  uint64_t resp;
+  return access(true, addr, data, &resp);
+}
+
+bool TLMMIOSim::read(uint64_t addr, uint64_t *resp) {
+  return access(false, addr, 0, resp);
+}
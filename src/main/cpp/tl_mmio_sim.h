@@ -0,0 +1,24 @@
+#ifndef TL_MMIO_SIM_H_
+#define TL_MMIO_SIM_H_
+
+#include "simulator.h"
+#include "VTLRandomForestReplayHarness.h"
+
+#define VPREFIX VTLRandomForestReplayHarness
+
+// Must match the address sets used by TLRandomForestReplayHarness
+static const uint64_t harness_csr_address = 0x1100;
+static const uint64_t harness_scratchpad_address = 0x200000;
+
+// Drives 8 byte Get and PutFullData accesses on the harness TileLink port
+class TLMMIOSim : public Simulator<VPREFIX> {
+    public:
+        TLMMIOSim(char* vcd_filename);
+
+    protected:
+        bool access(bool write, uint64_t addr, uint64_t data, uint64_t* resp);
+        bool write(uint64_t addr, uint64_t data);
+        bool read(uint64_t addr, uint64_t* resp);
+};
+
+#endif // TL_MMIO_SIM_H_
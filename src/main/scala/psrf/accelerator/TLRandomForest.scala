@@ -3,7 +3,7 @@ package psrf.accelerator
 import chipsalliance.rocketchip.config.{Config, Field}
 import freechips.rocketchip.diplomacy.{AddressSet, LazyModule}
 import freechips.rocketchip.subsystem.BaseSubsystem
-import psrf.params.{DecisionTreeConfig, DecisionTreeConfigKey, FixedPointBinaryPoint, FixedPointWidth, MaxTrees}
+import psrf.params.{DecisionTreeConfig, DecisionTreeConfigKey, FixedPointBinaryPoint, FixedPointWidth, MaxTrees, NumWalkers}
 
 case class TLRandomForestConfig(
   val csrAddress: AddressSet,
@@ -39,7 +39,8 @@ class WithTLRandomForest(
   maxNodes: Int = 1000,
   maxClasses: Int = 10,
   maxDepth: Int = 10,
-  maxTrees: Int = 100
+  maxTrees: Int = 100,
+  numWalkers: Int = 1
 ) extends Config((site, here, up) => {
   case TLRandomForestKey => Some(TLRandomForestConfig(csrAddress, scratchpadAddress))
   case FixedPointWidth => fixedPointWidth
@@ -51,4 +52,5 @@ class WithTLRandomForest(
     maxDepth = maxDepth
   )
   case MaxTrees => maxTrees
+  case NumWalkers => numWalkers
 })
@@ -5,10 +5,10 @@ import chisel3.util._
 import chipsalliance.rocketchip.config.Parameters
 import chisel3.experimental.FixedPoint
 import freechips.rocketchip.diplomacy.{AddressSet, LazyModule, LazyModuleImp}
-import freechips.rocketchip.regmapper.{RegField, RegFieldDesc, RegisterRouter, RegisterRouterParams}
+import freechips.rocketchip.regmapper.{RegField, RegFieldDesc, RegReadFn, RegWriteFn, RegisterRouter, RegisterRouterParams}
 import freechips.rocketchip.tilelink.HasTLControlRegMap
 import psrf.modules.RandomForestMMIOModule
-import psrf.params.{DecisionTreeConfigKey, HasDecisionTreeParams}
+import psrf.params.{DecisionTreeConfigKey, HasDecisionTreeParams, HasRandomForestParams}
 
 class Candidate()(implicit val p: Parameters) extends Bundle with HasDecisionTreeParams {
   val data = FixedPoint(fixedPointWidth.W, fixedPointBinaryPoint.BP)
@@ -25,7 +25,7 @@ abstract class RandomForestMMIO(
     base = csrAddress.base,
     size = csrAddress.mask + 1,
     beatBytes = beatBytes))
-    with HasDecisionTreeParams
+    with HasRandomForestParams
 {
   // TODO: Should I just mark this as 64bits
   val dataWidth = beatBytes * 8
@@ -39,6 +39,7 @@ abstract class RandomForestMMIO(
     // TODO: Revisit the constants
     val numTrees = RegInit(1.U(10.W))
     val numClasses = RegInit(1.U(10.W))
+    val compactNodes = RegInit(false.B)
 
     val error = Wire(UInt(2.W))
     val decision = Wire(UInt(32.W))
@@ -52,6 +53,7 @@ abstract class RandomForestMMIO(
 
     mmioHandler.numTrees := numTrees
     mmioHandler.numClasses := numClasses
+    mmioHandler.compactNodes := compactNodes
 
     mmioHandler.candidateData.valid := false.B
     mmioHandler.candidateData.bits := DontCare
@@ -77,17 +79,20 @@ abstract class RandomForestMMIO(
       when (valid) {
         numTrees := data(9, 0)
         numClasses := data(19, 10)
+        compactNodes := data(20)
       }
       !mmioHandler.busy
     }
 
     val csr = Cat(0.U(62.W), impl.io.busy, decisionValid)
+    val meta = Cat(0.U(32.W), numWalkers.U(8.W), 0.U(3.W), compactNodes, numClasses, numTrees)
 
     regmap(
       beatBytes * 0 -> Seq(RegField.r(dataWidth, csr, RegFieldDesc(name="csr", desc="Control Status Register"))),
       beatBytes * 1 -> Seq(RegField.w(dataWidth, handleCandidate(_, _), RegFieldDesc(name="candidate-in", desc="Port for passing candidates"))),
       beatBytes * 2 -> Seq(RegField.r(dataWidth, handleResult(_), RegFieldDesc(name="decision", desc="Result of a classification"))),
-      beatBytes * 3 -> Seq(RegField.w(dataWidth, handleMeta(_, _)))
+      beatBytes * 3 -> Seq(RegField(dataWidth, RegReadFn(meta), RegWriteFn(handleMeta(_, _)),
+        RegFieldDesc(name="meta", desc="Tree count, class count and node format, reads back the walker count")))
     )
   }
 }
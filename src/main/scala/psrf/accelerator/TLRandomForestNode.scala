@@ -2,19 +2,24 @@ package psrf.accelerator
 
 import chisel3._
 import chipsalliance.rocketchip.config.Parameters
-import chisel3.experimental.FixedPoint
-import chisel3.util.{Enum, log2Ceil}
+import chisel3.util.log2Ceil
 import freechips.rocketchip.diplomacy.{AddressSet, IdRange, LazyModule, LazyModuleImp}
-import psrf.modules.{RandomForestNodeModule, TreeIO, TreeNode}
-import psrf.params.HasDecisionTreeParams
+import psrf.modules.{RandomForestWalkersModule, TreeIO}
+import psrf.params.HasRandomForestParams
 import testchipip.TLHelper
 
+/** Tree walkers sharing one TileLink master. Each walker owns a source id starting
+  * at id.start, so every walker can have a scratchpad read in flight at once.
+  */
 class TLRandomForestNode(val address: AddressSet,
   id: IdRange = IdRange(0, 1),
   beatBytes: Int = 4,
   aligned: Boolean = false,
-)(implicit p: Parameters) extends LazyModule with HasDecisionTreeParams {
-  val psrfMaster = TLHelper.makeClientNode(name=name, sourceId = id)
+)(implicit p: Parameters) extends LazyModule with HasRandomForestParams {
+  require(numWalkers >= 1 && numWalkers < 256, "walker count is reported in 8 bits of the meta register")
+
+  val walkerIds = IdRange(id.start, id.start + numWalkers)
+  val psrfMaster = TLHelper.makeClientNode(name=name, sourceId = walkerIds)
 
   lazy val module = new LazyModuleImp(this) {
     val (mem, edge) = psrfMaster.out.head
@@ -22,21 +27,22 @@ class TLRandomForestNode(val address: AddressSet,
     val beatBytesShift = log2Ceil(beatBytes)
 
     val io = IO(new TreeIO()(p))
-    val rfNode = Module(new RandomForestNodeModule(address.base, address.mask, beatBytesShift)(p))
+    val walkers = Module(new RandomForestWalkersModule(address.base, address.mask, beatBytesShift)(p))
 
-    rfNode.io <> io
+    walkers.io <> io
 
-    rfNode.busReq.ready := mem.a.ready
+    walkers.busReq.ready := mem.a.ready
     mem.a.bits := edge.Get(
-      fromSource = 0.U,
-      toAddress = rfNode.busReq.bits,
+      fromSource = walkerIds.start.U + walkers.busReq.bits.walker,
+      toAddress = walkers.busReq.bits.address,
       lgSize = log2Ceil(beatBytes).U)._2
-    mem.a.valid := rfNode.busReq.valid
+    mem.a.valid := walkers.busReq.valid
 
-    mem.d.ready := rfNode.busResp.ready
-    rfNode.busResp.bits := mem.d.bits.data
-    rfNode.busResp.valid := mem.d.valid
+    walkers.busReqDone := edge.done(mem.a)
 
-    rfNode.busReqDone := edge.done(mem.a)
+    mem.d.ready := walkers.busResp.ready
+    walkers.busResp.bits.data := mem.d.bits.data
+    walkers.busResp.bits.walker := mem.d.bits.source - walkerIds.start.U
+    walkers.busResp.valid := mem.d.valid
   }
 }
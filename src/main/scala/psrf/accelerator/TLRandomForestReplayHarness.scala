@@ -0,0 +1,54 @@
+package psrf.accelerator
+
+import chipsalliance.rocketchip.config.Parameters
+import chisel3.stage.ChiselStage
+import freechips.rocketchip.diplomacy.{AddressSet, BundleBridgeSource, InModuleBody, LazyModule, LazyModuleImp}
+import freechips.rocketchip.tilelink.{BundleBridgeToTL, TLBundle, TLBundleParameters, TLMasterParameters, TLMasterPortParameters}
+
+/** Accelerator and scratchpad behind a single TileLink client port, without a SoC.
+  * This is the top level used by the MMIO trace replay driver in src/main/cpp.
+  */
+class TLRandomForestReplayHarness(
+  csrAddress: AddressSet,
+  scratchpadAddress: AddressSet,
+  beatBytes: Int = 8
+)(implicit p: Parameters) extends LazyModule {
+  val psrf = LazyModule(new TLDecisionTreeWithScratchpad(csrAddress, scratchpadAddress, beatBytes, beatBytes)(p))
+
+  val tlParams = TLBundleParameters(
+    addressBits = 32,
+    dataBits = beatBytes * 8,
+    sourceBits = 1,
+    sinkBits = 1,
+    sizeBits = 3,
+    echoFields = Nil,
+    requestFields = Nil,
+    responseFields = Nil,
+    hasBCE = false
+  )
+  val ioInNode = BundleBridgeSource(() => TLBundle(tlParams))
+
+  psrf.node := BundleBridgeToTL(TLMasterPortParameters.v1(Seq(TLMasterParameters.v1("replay")))) := ioInNode
+  // In a SoC the node walker reaches the scratchpad through pbus, here it goes straight to the xbar
+  psrf.xbar := psrf.mmio.tlMaster.psrfMaster
+
+  val tl = InModuleBody { ioInNode.makeIO() }
+
+  lazy val module = new LazyModuleImp(this)
+}
+
+/** Emits the harness, `--walkers N` sets the number of tree walkers and other
+  * arguments are passed on to the ChiselStage.
+  */
+object TLRandomForestReplayHarness extends App {
+  val csrAddress = AddressSet(0x1100, 0xff)
+  val scratchpadAddress = AddressSet(0x200000, 0x1ffff)
+
+  val walkersArg = args.indexOf("--walkers")
+  val numWalkers = if (walkersArg >= 0) args(walkersArg + 1).toInt else 1
+  val stageArgs = if (walkersArg >= 0) args.patch(walkersArg, Nil, 2) else args
+
+  implicit val p: Parameters = new WithTLRandomForest(csrAddress, scratchpadAddress, numWalkers = numWalkers)
+
+  (new ChiselStage).emitVerilog(LazyModule(new TLRandomForestReplayHarness(csrAddress, scratchpadAddress)).module, stageArgs)
+}
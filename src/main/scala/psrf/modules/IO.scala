@@ -3,7 +3,7 @@ package psrf.modules
 import chipsalliance.rocketchip.config.Parameters
 import chisel3._
 import chisel3.util.{Decoupled, log2Ceil}
-import psrf.params.HasDecisionTreeParams
+import psrf.params.{HasDecisionTreeParams, HasRandomForestParams}
 import chisel3.experimental.FixedPoint
 
 class TreeInputBundle()(implicit val p: Parameters) extends Bundle with HasDecisionTreeParams {
@@ -14,6 +14,8 @@ class TreeInputBundle()(implicit val p: Parameters) extends Bundle with HasDecis
 class TreeOutputBundle() extends Bundle {
   val classes = UInt(9.W)
   val error = UInt(2.W)
+  // Tree the result belongs to, walkers can finish out of order
+  val tree = UInt(10.W)
 }
 
 class TreeNode()(implicit val p: Parameters) extends Bundle with HasDecisionTreeParams {
@@ -24,6 +26,28 @@ class TreeNode()(implicit val p: Parameters) extends Bundle with HasDecisionTree
   val rightNode = UInt(11.W)
 }
 
+/** Node packed into 32 bits, two per 64-bit scratchpad beat. The left child always
+  * follows its parent and the threshold is quantized with a per-feature scale that
+  * the SDK also applies to the candidates, so it compares as a sign-extended fixed point.
+  */
+class CompactTreeNode() extends Bundle {
+  val isLeafNode = Bool()
+  val featureClassIndex = UInt(5.W)
+  val rightNode = UInt(10.W)
+  val threshold = SInt(16.W)
+}
+
+/** Scratchpad read from one of several walkers, tagged with the walker index. */
+class WalkerBusReq()(implicit val p: Parameters) extends Bundle with HasRandomForestParams {
+  val address = UInt(32.W)
+  val walker = UInt(walkerIndexWidth.W)
+}
+
+class WalkerBusResp()(implicit val p: Parameters) extends Bundle with HasRandomForestParams {
+  val data = UInt(64.W)
+  val walker = UInt(walkerIndexWidth.W)
+}
+
 // TODO: The width of in interface should be reduced, we are assuming that
 //  our features are going to be less. This potentially can be a Wishbone Slave
 //
@@ -31,4 +55,5 @@ class TreeIO()(implicit val p: Parameters) extends Bundle with HasDecisionTreePa
   val in = Flipped(Decoupled(new TreeInputBundle()))
   val out = Decoupled(new TreeOutputBundle())
   val busy = Output(Bool())
+  val compactNodes = Input(Bool())
 }
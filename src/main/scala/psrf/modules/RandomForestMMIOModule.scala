@@ -19,6 +19,7 @@ class RandomForestMMIOModule()(implicit val p: Parameters) extends Module with H
   val busy = IO(Output(Bool()))
   val numTrees = IO(Input(UInt(10.W)))
   val numClasses = IO(Input(UInt(10.W)))
+  val compactNodes = IO(Input(Bool()))
 
   val majorityVoter = Module(new MajorityVoterModule()(p))
 
@@ -27,7 +28,9 @@ class RandomForestMMIOModule()(implicit val p: Parameters) extends Module with H
 
   val candidates = Reg(Vec(maxFeatures, FixedPoint(fixedPointWidth.W, fixedPointBinaryPoint.BP)))
 
+  // Next tree to hand to a walker and number of trees whose result is back
   val currTree = RegInit(0.U((log2Ceil(maxTrees)+1).W))
+  val doneTrees = RegInit(0.U((log2Ceil(maxTrees)+1).W))
   // Decision from all the trees
   // TODO: How do I know everything is complete
   val decisions = Reg(Vec(maxTrees, UInt(9.W)))
@@ -41,7 +44,8 @@ class RandomForestMMIOModule()(implicit val p: Parameters) extends Module with H
   //val candidateLast = Wire(Bool())
   val activeClassification = RegInit(false.B)
 
-  busy := state =/= s_idle
+  // Walkers still finishing an aborted classification keep us busy
+  busy := state =/= s_idle || io.busy
 
   majorityVoter.io.in.valid := false.B
   majorityVoter.io.in.bits := DontCare
@@ -50,12 +54,14 @@ class RandomForestMMIOModule()(implicit val p: Parameters) extends Module with H
   majorityVoter.io.numClasses := numClasses
   majorityVoter.io.numTrees := numTrees
 
-  candidateData.ready := state === s_idle
+  candidateData.ready := state === s_idle && !io.busy
 
   decisionValidIO := decisionValid
   decisionIO := decision
   errorIO := error
 
+  io.compactNodes := compactNodes
+
   io.in.valid := false.B
   io.in.bits.candidates := DontCare
   io.in.bits.offset := DontCare
@@ -73,16 +79,21 @@ class RandomForestMMIOModule()(implicit val p: Parameters) extends Module with H
     when(last) {
       state := s_busy
       currTree := 0.U
+      doneTrees := 0.U
     }
   }
 
-  when(state === s_busy && io.in.ready && !io.busy) {
+  when(state === s_busy && currTree < numTrees) {
     io.in.bits.candidates := candidates
     io.in.bits.offset := currTree
     io.in.valid := activeClassification
   }
 
-  when (state === s_busy && currTree === numTrees) {
+  when(io.in.fire) {
+    currTree := currTree + 1.U
+  }
+
+  when (state === s_busy && doneTrees === numTrees) {
     state := s_count
     majorityVoter.io.in.valid := true.B
     majorityVoter.io.in.bits := decisions
@@ -100,12 +111,12 @@ class RandomForestMMIOModule()(implicit val p: Parameters) extends Module with H
 
   io.out.ready := true.B
   when(io.out.fire) {
-    decisions(currTree) := io.out.bits.classes
-    errors(currTree) := io.out.bits.error
-    currTree := currTree + 1.U
+    decisions(io.out.bits.tree) := io.out.bits.classes
+    errors(io.out.bits.tree) := io.out.bits.error
+    doneTrees := doneTrees + 1.U
   }
 
-  when (io.out.fire && io.out.bits.error =/= 0.U) {
+  when (state === s_busy && io.out.fire && io.out.bits.error =/= 0.U) {
     decisionValid := true.B
     activeClassification := false.B
     state := s_done
@@ -116,6 +127,7 @@ class RandomForestMMIOModule()(implicit val p: Parameters) extends Module with H
     decisionValid := false.B
     state := s_idle
     currTree := 0.U
+    doneTrees := 0.U
   }
   
 }
@@ -19,18 +19,24 @@ class RandomForestNodeModule(
   val busReqDone = IO(Input(Bool()))
   val busResp = IO(Flipped(Decoupled(UInt(64.W))))
 
-  val idle :: bus_req_wait :: bus_req :: bus_resp_wait :: done :: Nil = Enum(5)
+  val idle :: bus_req_wait :: bus_req :: bus_resp_wait :: beat_hit :: done :: Nil = Enum(6)
   val state = RegInit(idle)
   val candidate = Reg(Vec(maxFeatures, FixedPoint(fixedPointWidth.W, fixedPointBinaryPoint.BP)))
 
   val node_rd = Reg(new TreeNode()(p))
   val nodeAddr = RegInit(address_base.U)
 
+  // Compact nodes are 4 bytes, the last fetched beat is kept so that a child
+  // sharing it is walked without another bus request
+  val compactNodeShift = 2
+  val beat = Reg(UInt(64.W))
+
   val inputCountCond = WireDefault(false.B)
   val resetCounter = WireDefault(false.B)
   val (_, inputCountWrap) = Counter(Range(0, maxDepth, 1), inputCountCond, resetCounter)
 
   val error = RegInit(0.U(2.W))
+  val tree = Reg(UInt(10.W))
 
   //val offset = Reg(UInt(32.W))
 
@@ -40,6 +46,7 @@ class RandomForestNodeModule(
   io.out.valid := state === done
   io.out.bits.classes := node_rd.featureClassIndex
   io.out.bits.error := error
+  io.out.bits.tree := tree
 
   // TODO: Add a condition to make sure nodeAddress does not exceed scratchpad size
   val scratchpadLimit = address_base + address_mask
@@ -49,12 +56,13 @@ class RandomForestNodeModule(
   }
 
   busReq.valid := state === bus_req
-  busReq.bits := nodeAddr
+  busReq.bits := (nodeAddr >> beatBytesShift) << beatBytesShift
 
   busResp.ready := state === bus_resp_wait
 
   when(state === idle && io.in.fire) {
     candidate := io.in.bits.candidates
+    tree := io.in.bits.offset
     //offset := address.base.U(32.W) + (io.in.bits.offset << beatBytesShift)
     nodeAddr := address_base.U + (io.in.bits.offset << beatBytesShift)
     state := bus_req_wait
@@ -71,32 +79,62 @@ class RandomForestNodeModule(
     state := bus_resp_wait
   }
 
+  def nodeFromBeat(data: UInt): TreeNode = {
+    val compactWord = if (beatBytesShift > compactNodeShift) {
+      Mux(nodeAddr(compactNodeShift), data(63, 32), data(31, 0))
+    } else {
+      data(31, 0)
+    }
+    val compact = compactWord.asTypeOf(new CompactTreeNode())
+
+    val expanded = Wire(new TreeNode()(p))
+    expanded.isLeafNode := compact.isLeafNode
+    expanded.featureClassIndex := compact.featureClassIndex
+    expanded.threshold := compact.threshold.pad(fixedPointWidth).asTypeOf(expanded.threshold)
+    expanded.leftNode := 1.U
+    expanded.rightNode := compact.rightNode
+
+    Mux(io.compactNodes, expanded, data.asTypeOf(node_rd))
+  }
+
+  def walk(node: TreeNode): Unit = {
+    inputCountCond := true.B
+    node_rd := node
+
+    val featureIndex = node.featureClassIndex
+    val featureValue = candidate(featureIndex) // TODO: Can this result in an exception
+
+    when(node.isLeafNode) {
+      state := done
+    }.otherwise {
+      val jumpOffset: UInt = Mux(featureValue <= node.threshold, node.leftNode, node.rightNode)
+      val nextAddr = nodeAddr + Mux(io.compactNodes, jumpOffset << compactNodeShift, jumpOffset << beatBytesShift)
+      val sameBeat = io.compactNodes && (nextAddr >> beatBytesShift) === (nodeAddr >> beatBytesShift)
+      nodeAddr := nextAddr
+      state := Mux(sameBeat, beat_hit, bus_req_wait)
+    }
+  }
+
   when(state === bus_resp_wait && busResp.fire) {
+    beat := busResp.bits
     // First time we get tree's root node address
     when(readRootNode) {
       // TODO: Move the constant 128 outside
-      nodeAddr := address_base.U + ((128.U + busResp.bits) << beatBytesShift)
+      nodeAddr := Mux(io.compactNodes,
+        (address_base + (128 << beatBytesShift)).U + (busResp.bits << compactNodeShift),
+        address_base.U + ((128.U + busResp.bits) << beatBytesShift))
       readRootNode := false.B
       state := bus_req_wait
     }.otherwise {
       // Rest of the time it's nodes for the tree
-      inputCountCond := true.B
-      val node = busResp.bits.asTypeOf(node_rd)
-      node_rd := node
-
-      val featureIndex = node.featureClassIndex
-      val featureValue = candidate(featureIndex) // TODO: Can this result in an exception
-
-      when(node.isLeafNode) {
-        state := done
-      }.otherwise {
-        val jumpOffset: UInt = Mux(featureValue <= node.threshold, node.leftNode, node.rightNode)
-        nodeAddr := nodeAddr + (jumpOffset.asUInt << beatBytesShift)
-        state := bus_req_wait
-      }
+      walk(nodeFromBeat(busResp.bits))
     }
   }
 
+  when(state === beat_hit) {
+    walk(nodeFromBeat(beat))
+  }
+
   when(inputCountWrap) {
     state := done
     error := 2.U
@@ -0,0 +1,57 @@
+package psrf.modules
+
+import chisel3._
+import chisel3.util._
+import chipsalliance.rocketchip.config.Parameters
+import psrf.params.HasRandomForestParams
+
+/** numWalkers tree walkers behind a single TreeIO. Trees go to the first idle walker
+  * and results come back in whichever order walkers finish. Bus reads are arbitrated
+  * round robin and tagged with the walker index, so every walker can have one in flight.
+  */
+class RandomForestWalkersModule(
+  val address_base: BigInt,
+  val address_mask: BigInt,
+  val beatBytesShift: Int
+)(implicit val p: Parameters) extends Module
+  with HasRandomForestParams {
+
+  val io = IO(new TreeIO()(p))
+
+  val busReq = IO(Decoupled(new WalkerBusReq()(p)))
+  val busReqDone = IO(Input(Bool()))
+  val busResp = IO(Flipped(Decoupled(new WalkerBusResp()(p))))
+
+  val rfNodes = Seq.fill(numWalkers)(Module(new RandomForestNodeModule(address_base, address_mask, beatBytesShift)(p)))
+
+  val idleWalkers = VecInit(rfNodes.map(_.io.in.ready))
+  val nextWalker = PriorityEncoder(idleWalkers)
+  val outArb = Module(new RRArbiter(new TreeOutputBundle(), numWalkers))
+  val reqArb = Module(new RRArbiter(UInt(32.W), numWalkers))
+
+  io.in.ready := idleWalkers.asUInt.orR
+  io.out <> outArb.io.out
+  io.busy := rfNodes.map(_.io.busy).reduce(_ || _)
+
+  for ((rfNode, i) <- rfNodes.zipWithIndex) {
+    rfNode.io.in.valid := io.in.valid && nextWalker === i.U
+    rfNode.io.in.bits := io.in.bits
+    rfNode.io.compactNodes := io.compactNodes
+    outArb.io.in(i) <> rfNode.io.out
+
+    reqArb.io.in(i) <> rfNode.busReq
+    rfNode.busReqDone := busReqDone && reqArb.io.chosen === i.U
+
+    rfNode.busResp.bits := busResp.bits.data
+    rfNode.busResp.valid := busResp.valid && busResp.bits.walker === i.U
+  }
+
+  busReq.valid := reqArb.io.out.valid
+  busReq.bits.address := reqArb.io.out.bits
+  busReq.bits.walker := reqArb.io.chosen
+  reqArb.io.out.ready := busReq.ready
+
+  busResp.ready := Mux1H(rfNodes.zipWithIndex.map { case (rfNode, i) =>
+    (busResp.bits.walker === i.U) -> rfNode.busResp.ready
+  })
+}
@@ -33,6 +33,9 @@ case class DecisionTreeConfig(
 
 case object MaxTrees extends Field[Int]
 
+/** Number of tree walkers sharing the scratchpad master. */
+case object NumWalkers extends Field[Int](1)
+
 case object DecisionTreeConfigKey extends Field[DecisionTreeConfig]
 
 trait HasDecisionTreeParams extends HasFixedPointParams {
@@ -55,4 +58,6 @@ trait HasDecisionTreeParams extends HasFixedPointParams {
 trait HasRandomForestParams extends HasDecisionTreeParams {
   implicit val p: Parameters
   val maxTrees = p(MaxTrees)
+  val numWalkers = p(NumWalkers)
+  val walkerIndexWidth = math.max(log2Ceil(numWalkers), 1)
 }
@@ -27,6 +27,17 @@ case class TreeNodeLit(
   }
 }
 
+case class CompactTreeNodeLit(
+  leaf: Int,
+  featureIndex: Int,
+  threshold: Int,
+  rightNode: Int
+) {
+
+  def toBinary: BigInt =
+    (BigInt(leaf) << 31) | (BigInt(featureIndex) << 26) | (BigInt(rightNode) << 16) | BigInt(threshold & 0xffff)
+}
+
 object Helper {
   def toFixedPoint(x: Double, scale: Long): Long = {
     val BP_SCALE = 1L << scale
@@ -102,7 +102,8 @@ class RandomForestMMIOModuleSpec extends AnyFlatSpec with ChiselScalatestTester
 
         val result = new TreeOutputBundle().Lit(
           _.classes -> 1.U,
-          _.error -> 0.U
+          _.error -> 0.U,
+          _.tree -> 0.U
         )
 
         dut.numClasses.poke(4.U)
@@ -154,9 +155,10 @@ class RandomForestMMIOModuleSpec extends AnyFlatSpec with ChiselScalatestTester
           _.candidates -> Vec.Lit(candidate1.F(32.W, 16.BP), candidate2.F(32.W, 16.BP)),
           _.offset -> 2.U)
 
-        val result = new TreeOutputBundle().Lit(
+        def result(tree: Int) = new TreeOutputBundle().Lit(
           _.classes -> 2.U,
-          _.error -> 0.U
+          _.error -> 0.U,
+          _.tree -> tree.U
         )
 
         dut.numClasses.poke(3.U)
@@ -169,16 +171,16 @@ class RandomForestMMIOModuleSpec extends AnyFlatSpec with ChiselScalatestTester
 
         dut.io.in.expectDequeue(expected0)
         dut.busy.expect(true.B)
-        dut.io.out.enqueue(result)
+        dut.io.out.enqueue(result(0))
         dut.decisionValidIO.expect(false.B)
 
         dut.io.in.expectDequeue(expected1)
         dut.busy.expect(true.B)
-        dut.io.out.enqueue(result)
+        dut.io.out.enqueue(result(1))
         dut.decisionValidIO.expect(false.B)
 
         dut.io.in.expectDequeue(expected2)
-        dut.io.out.enqueue(result)
+        dut.io.out.enqueue(result(2))
 
         dut.clock.step(8)
 
@@ -216,12 +218,20 @@ class RandomForestMMIOModuleSpec extends AnyFlatSpec with ChiselScalatestTester
 
         val result0 = new TreeOutputBundle().Lit(
           _.classes -> 2.U,
-          _.error -> 0.U
+          _.error -> 0.U,
+          _.tree -> 0.U
         )
 
         val result1 = new TreeOutputBundle().Lit(
           _.classes -> 1.U,
-          _.error -> 0.U
+          _.error -> 0.U,
+          _.tree -> 1.U
+        )
+
+        val result2 = new TreeOutputBundle().Lit(
+          _.classes -> 1.U,
+          _.error -> 0.U,
+          _.tree -> 2.U
         )
 
         dut.numClasses.poke(3.U)
@@ -243,7 +253,7 @@ class RandomForestMMIOModuleSpec extends AnyFlatSpec with ChiselScalatestTester
         dut.decisionValidIO.expect(false.B)
 
         dut.io.in.expectDequeue(expected2)
-        dut.io.out.enqueue(result1)
+        dut.io.out.enqueue(result2)
 
         dut.clock.step(8)
 
@@ -281,7 +291,8 @@ class RandomForestMMIOModuleSpec extends AnyFlatSpec with ChiselScalatestTester
 
         val result0 = new TreeOutputBundle().Lit(
           _.classes -> 2.U,
-          _.error -> 1.U
+          _.error -> 1.U,
+          _.tree -> 0.U
         )
 
         dut.numClasses.poke(3.U)
@@ -301,4 +312,118 @@ class RandomForestMMIOModuleSpec extends AnyFlatSpec with ChiselScalatestTester
       }
   }
 
+  it should "not accept candidates after an error until the walkers drain" in {
+    test(new RandomForestMMIOModule()(threeTreesParams))
+      .withAnnotations(Seq(WriteVcdAnnotation)) { dut =>
+        val helper = new RandomForestMMIOModuleSpecHelper(dut)
+
+        val candidate1 = 0.5
+        val candidate2 = 1.0
+
+        dut.candidateData.initSource()
+        dut.candidateData.setSourceClock(dut.clock)
+        dut.io.in.initSink()
+        dut.io.in.setSinkClock(dut.clock)
+        dut.io.out.initSource()
+        dut.io.out.setSourceClock(dut.clock)
+
+        val expected0 = new TreeInputBundle()(threeTreesParams).Lit(
+          _.candidates -> Vec.Lit(candidate1.F(32.W, 16.BP), candidate2.F(32.W, 16.BP)),
+          _.offset -> 0.U)
+
+        val result0 = new TreeOutputBundle().Lit(
+          _.classes -> 2.U,
+          _.error -> 1.U,
+          _.tree -> 0.U
+        )
+
+        dut.numClasses.poke(3.U)
+        dut.numTrees.poke(3.U)
+        dut.candidateData.enqueueSeq(Seq(
+          helper.createCandidate(candidate1).U,
+          helper.createCandidate(candidate2, 1).U
+        ))
+
+        dut.io.in.expectDequeue(expected0)
+
+        // Other walkers are still on trees of the failed request
+        dut.io.busy.poke(true.B)
+        dut.io.out.enqueue(result0)
+        dut.decisionValidIO.expect(true.B)
+        dut.errorIO.expect(1.U)
+
+        dut.resetDecision.poke(true.B)
+        dut.clock.step()
+        dut.resetDecision.poke(false.B)
+        dut.decisionValidIO.expect(false.B)
+
+        dut.candidateData.valid.poke(true.B)
+        dut.candidateData.bits.poke(helper.createCandidate(candidate1, 1).U)
+        for (_ <- 0 until 4) {
+          dut.busy.expect(true.B)
+          dut.candidateData.ready.expect(false.B)
+          dut.io.in.valid.expect(false.B)
+          dut.clock.step()
+        }
+
+        dut.io.busy.poke(false.B)
+        dut.busy.expect(false.B)
+        dut.candidateData.ready.expect(true.B)
+        dut.clock.step()
+        dut.candidateData.valid.poke(false.B)
+
+        dut.io.in.valid.expect(true.B)
+        dut.io.in.bits.offset.expect(0.U)
+      }
+  }
+
+  it should "dispatch trees before earlier results are back and accept them out of order" in {
+    test(new RandomForestMMIOModule()(threeTreesParams))
+      .withAnnotations(Seq(WriteVcdAnnotation)) { dut =>
+        val helper = new RandomForestMMIOModuleSpecHelper(dut)
+
+        val candidate1 = 0.5
+        val candidate2 = 1.0
+
+        dut.candidateData.initSource()
+        dut.candidateData.setSourceClock(dut.clock)
+        dut.io.in.initSink()
+        dut.io.in.setSinkClock(dut.clock)
+        dut.io.out.initSource()
+        dut.io.out.setSourceClock(dut.clock)
+
+        def expected(tree: Int) = new TreeInputBundle()(threeTreesParams).Lit(
+          _.candidates -> Vec.Lit(candidate1.F(32.W, 16.BP), candidate2.F(32.W, 16.BP)),
+          _.offset -> tree.U)
+
+        def result(tree: Int, classes: Int) = new TreeOutputBundle().Lit(
+          _.classes -> classes.U,
+          _.error -> 0.U,
+          _.tree -> tree.U
+        )
+
+        dut.numClasses.poke(3.U)
+        dut.numTrees.poke(3.U)
+        dut.candidateData.enqueueSeq(Seq(
+          helper.createCandidate(candidate1).U,
+          helper.createCandidate(candidate2, 1).U
+        ))
+
+        dut.io.in.expectDequeue(expected(0))
+        dut.io.in.expectDequeue(expected(1))
+        dut.io.in.expectDequeue(expected(2))
+        dut.io.in.valid.expect(false.B)
+
+        dut.io.out.enqueue(result(2, 0))
+        dut.io.out.enqueue(result(0, 1))
+        dut.decisionValidIO.expect(false.B)
+        dut.io.out.enqueue(result(1, 1))
+
+        dut.clock.step(8)
+
+        dut.decisionValidIO.expect(true.B)
+        dut.decisionIO.expect(1)
+      }
+  }
+
 }
@@ -264,5 +264,140 @@ class RandomForestNodeModuleSpec extends AnyFlatSpec with ChiselScalatestTester
         }
     }
 
-}
+    it should "walk compact nodes sharing a beat without another bus request" in {
+      test(new RandomForestNodeModule(0x2000, 0xfff, 3)(twoTreeParams))
+        .withAnnotations(Seq(WriteVcdAnnotation)) { dut =>
+
+          val helper = new RandomForestNodeHelper(dut)
+
+          val inCandidates = Seq(0.25, 2)
+          val treeNode0 = CompactTreeNodeLit(0, 0, Helper.toFixedPoint(0.375, Constants.bpWidth).toInt, 2)
+          val treeNode1 = CompactTreeNodeLit(1, 2, 0, 0)
+
+          val candidate = inCandidates.asFixedPointVecLit(
+            twoTreeParams(FixedPointWidth).W,
+            twoTreeParams(FixedPointBinaryPoint).BP)
+
+          dut.io.compactNodes.poke(true.B)
+          dut.io.in.ready.expect(true.B) //idle
+          dut.io.in.valid.poke(true.B)
+          dut.io.in.bits.offset.poke(0.U)
+          dut.io.in.bits.candidates.poke(candidate)
+          dut.clock.step()
+
+          dut.busReq.ready.poke(true.B) //bus_req_wait
+          dut.clock.step()
+
+          dut.busReq.valid.expect(true.B) //bus_req
+          dut.busReq.bits.expect(0x2000)
+          dut.busReqDone.poke(true.B)
+
+          helper.handleReq(0)
+          dut.clock.step() //bus_req_wait to bus_req
+
+          dut.busReq.bits.expect(0x2400)
+          helper.handleReq(treeNode0.toBinary | (treeNode1.toBinary << 32))
+
+          dut.busReq.valid.expect(false.B) //beat_hit
+          dut.busResp.ready.expect(false.B)
+          dut.clock.step()
+
+          dut.io.out.valid.expect(true.B)
+          dut.io.out.bits.error.expect(0.U)
+          dut.io.out.bits.classes.expect(2.U)
+        }
+    }
+
+    it should "read an odd compact root from the high half and jump right into the next beat" in {
+      test(new RandomForestNodeModule(0x2000, 0xfff, 3)(twoTreeParams))
+        .withAnnotations(Seq(WriteVcdAnnotation)) { dut =>
+
+          val helper = new RandomForestNodeHelper(dut)
+
+          // Negative threshold only sends -0.125 right when it is sign extended
+          val inCandidates = Seq(-0.125, 2)
+          val decoy = CompactTreeNodeLit(1, 3, 0, 0)
+          val treeNode1 = CompactTreeNodeLit(0, 0, Helper.toFixedPoint(-0.25, Constants.bpWidth).toInt, 2)
+          val treeNode2 = CompactTreeNodeLit(1, 1, 0, 0)
+          val treeNode3 = CompactTreeNodeLit(1, 2, 0, 0)
+
+          val candidate = inCandidates.asFixedPointVecLit(
+            twoTreeParams(FixedPointWidth).W,
+            twoTreeParams(FixedPointBinaryPoint).BP)
+
+          dut.io.compactNodes.poke(true.B)
+          dut.io.in.ready.expect(true.B) //idle
+          dut.io.in.valid.poke(true.B)
+          dut.io.in.bits.offset.poke(0.U)
+          dut.io.in.bits.candidates.poke(candidate)
+          dut.clock.step()
+
+          dut.busReq.ready.poke(true.B) //bus_req_wait
+          dut.clock.step()
+
+          dut.busReq.bits.expect(0x2000) //bus_req
+          dut.busReqDone.poke(true.B)
 
+          helper.handleReq(1)
+          dut.clock.step() //bus_req_wait to bus_req
+
+          dut.busReq.bits.expect(0x2400)
+          helper.handleReq(decoy.toBinary | (treeNode1.toBinary << 32))
+
+          dut.busReq.valid.expect(false.B) //bus_req_wait, right child is in the next beat
+          dut.clock.step()
+
+          dut.busReq.valid.expect(true.B) //bus_req
+          dut.busReq.bits.expect(0x2408)
+          helper.handleReq(treeNode2.toBinary | (treeNode3.toBinary << 32))
+
+          dut.io.out.valid.expect(true.B)
+          dut.io.out.bits.error.expect(0.U)
+          dut.io.out.bits.classes.expect(2.U)
+        }
+    }
+
+    it should "walk wide nodes when compact nodes are disabled" in {
+      test(new RandomForestNodeModule(0x2000, 0xfff, 3)(twoTreeParams))
+        .withAnnotations(Seq(WriteVcdAnnotation)) { dut =>
+
+          val helper = new RandomForestNodeHelper(dut)
+
+          val inCandidates = Seq(1.5, 2)
+          val treeNode0 = TreeNodeLit(0, 0, Helper.toFixedPoint(0.5, Constants.bpWidth), 1, 2)
+          val treeNode2 = TreeNodeLit(1, 3, 0, 0, 0)
+
+          val candidate = inCandidates.asFixedPointVecLit(
+            twoTreeParams(FixedPointWidth).W,
+            twoTreeParams(FixedPointBinaryPoint).BP)
+
+          dut.io.compactNodes.poke(false.B)
+          dut.io.in.ready.expect(true.B) //idle
+          dut.io.in.valid.poke(true.B)
+          dut.io.in.bits.offset.poke(0.U)
+          dut.io.in.bits.candidates.poke(candidate)
+          dut.clock.step()
+
+          dut.busReq.ready.poke(true.B) //bus_req_wait
+          dut.clock.step()
+
+          dut.busReq.bits.expect(0x2000) //bus_req
+          dut.busReqDone.poke(true.B)
+
+          helper.handleReq(0)
+          dut.clock.step() //bus_req_wait to bus_req
+
+          dut.busReq.bits.expect(0x2400)
+          helper.handleReq(treeNode0)
+          dut.clock.step() //bus_req_wait to bus_req
+
+          dut.busReq.bits.expect(0x2410)
+          helper.handleReq(treeNode2)
+
+          dut.io.out.valid.expect(true.B)
+          dut.io.out.bits.error.expect(0.U)
+          dut.io.out.bits.classes.expect(3.U)
+        }
+    }
+
+}
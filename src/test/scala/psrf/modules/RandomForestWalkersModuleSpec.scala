@@ -0,0 +1,122 @@
+package psrf.modules
+
+import chisel3._
+import chipsalliance.rocketchip.config.{Config, Parameters}
+import chiseltest._
+import org.scalatest.flatspec.AnyFlatSpec
+import psrf.params.{DecisionTreeConfig, DecisionTreeConfigKey, FixedPointBinaryPoint, FixedPointWidth, MaxTrees, NumWalkers}
+
+class RandomForestWalkersHelper(dut: RandomForestWalkersModule) {
+  // Wait for the next request, accept it and return (address, walker)
+  def acceptReq(): (BigInt, Int) = {
+    dut.busReq.ready.poke(true.B)
+    while (!dut.busReq.valid.peek().litToBoolean) {
+      dut.clock.step()
+    }
+    val address = dut.busReq.bits.address.peek().litValue
+    val walker = dut.busReq.bits.walker.peek().litValue.toInt
+    dut.busReqDone.poke(true.B)
+    dut.clock.step()
+    dut.busReqDone.poke(false.B)
+    (address, walker)
+  }
+
+  def handleResp(walker: Int, value: BigInt): Unit = {
+    dut.busResp.valid.poke(true.B)
+    dut.busResp.bits.walker.poke(walker.U)
+    dut.busResp.bits.data.poke(value.U(64.W))
+    dut.busResp.ready.expect(true.B)
+    dut.clock.step()
+    dut.busResp.valid.poke(false.B)
+  }
+}
+
+class RandomForestWalkersModuleSpec extends AnyFlatSpec with ChiselScalatestTester {
+  val twoWalkerParams: Parameters = new Config((site, here, up) => {
+    case FixedPointWidth => Constants.fpWidth
+    case FixedPointBinaryPoint => Constants.bpWidth
+    case DecisionTreeConfigKey => DecisionTreeConfig(
+      maxFeatures = 2,
+      maxNodes = 10,
+      maxClasses = 10,
+      maxDepth = 10
+    )
+    case MaxTrees => 2
+    case NumWalkers => 2
+  })
+
+  it should "route responses returned in reverse order to the walker that asked" in {
+    test(new RandomForestWalkersModule(0x2000, 0xfff, 3)(twoWalkerParams))
+      .withAnnotations(Seq(WriteVcdAnnotation)) { dut =>
+        val helper = new RandomForestWalkersHelper(dut)
+
+        val candidate = Seq(0.5, 2.0).asFixedPointVecLit(
+          twoWalkerParams(FixedPointWidth).W,
+          twoWalkerParams(FixedPointBinaryPoint).BP)
+
+        // Root offsets and leaf classes per tree
+        val roots = Map(0 -> 3, 1 -> 5)
+        val classes = Map(0 -> 1, 1 -> 2)
+        def rootTableAddr(tree: Int): BigInt = 0x2000 + (tree << 3)
+        def nodeAddr(tree: Int): BigInt = 0x2000 + ((128 + roots(tree)) << 3)
+
+        dut.io.compactNodes.poke(false.B)
+        dut.io.out.ready.poke(false.B)
+        dut.busReq.ready.poke(false.B)
+        dut.busReqDone.poke(false.B)
+        dut.busResp.valid.poke(false.B)
+
+        // Both trees are dispatched while no walker has reached the bus
+        dut.io.in.bits.candidates.poke(candidate)
+        for (tree <- 0 until 2) {
+          dut.io.in.valid.poke(true.B)
+          dut.io.in.bits.offset.poke(tree.U)
+          dut.io.in.ready.expect(true.B)
+          dut.clock.step()
+        }
+        dut.io.in.valid.poke(false.B)
+        dut.io.in.ready.expect(false.B)
+        dut.io.busy.expect(true.B)
+
+        // Releasing the bus lets both walkers request in the same cycle
+        dut.busReq.ready.poke(true.B)
+        dut.clock.step()
+        val first = helper.acceptReq()
+        val second = helper.acceptReq()
+        assert(first._2 != second._2)
+        assert(Set(first._1, second._1) == Set(rootTableAddr(0), rootTableAddr(1)))
+
+        val walkerTree = Seq(first, second).map { case (address, walker) =>
+          walker -> (if (address == rootTableAddr(0)) 0 else 1)
+        }.toMap
+
+        // Root offsets come back newest first
+        for ((_, walker) <- Seq(second, first)) {
+          helper.handleResp(walker, roots(walkerTree(walker)))
+        }
+
+        val nodeReqs = Seq(helper.acceptReq(), helper.acceptReq())
+        for ((address, walker) <- nodeReqs) {
+          assert(address == nodeAddr(walkerTree(walker)))
+        }
+
+        for ((_, walker) <- nodeReqs.reverse) {
+          helper.handleResp(walker, TreeNodeLit(1, classes(walkerTree(walker)), 0, 0, 0).toBinary)
+        }
+
+        dut.io.out.ready.poke(true.B)
+        var results = Map[Int, Int]()
+        var cycles = 0
+        while (results.size < 2 && cycles < 10) {
+          if (dut.io.out.valid.peek().litToBoolean) {
+            dut.io.out.bits.error.expect(0.U)
+            results += dut.io.out.bits.tree.peek().litValue.toInt -> dut.io.out.bits.classes.peek().litValue.toInt
+          }
+          dut.clock.step()
+          cycles += 1
+        }
+        assert(results == classes)
+        dut.io.busy.expect(false.B)
+      }
+  }
+}